@@ -0,0 +1,293 @@
+#include "AllocTracker.hpp"
+#include "IState.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Everything in here may run inside operator new, so nothing in this file
+// is allowed to allocate: fixed size tables, plain char arrays and stdio only.
+namespace {
+    // frames after a state stack change before the steady state begins,
+    // gives fonts/glyphs/vertex arrays the chance to be set up
+    const int WARMUP_FRAMES = 3;
+    const int MAX_TRACKED_STATES = 16;
+    const char *const PHASE_NAMES[AllocTracker::PhaseCount] = {"other", "handleInput", "update", "draw"};
+
+    struct StateCounts {
+        char name[32];
+        AllocTracker::Counts phases[AllocTracker::PhaseCount];
+    };
+
+    // totals, other threads may allocate, too
+    std::atomic<std::size_t> totalAllocations[AllocTracker::PhaseCount];
+    std::atomic<std::size_t> totalFrees[AllocTracker::PhaseCount];
+    std::atomic<std::size_t> totalBytes[AllocTracker::PhaseCount];
+
+    // only touched by the thread running the frame loop (phase != Other)
+    StateCounts stateCounts[MAX_TRACKED_STATES];
+    int stateCountsUsed = 0;
+    // current frame, without the explicitly allowed allocations
+    AllocTracker::Counts frameCounts[AllocTracker::PhaseCount];
+    bool violated = false;
+    AllocTracker::Phase violationPhase = AllocTracker::Other;
+    char violationState[32];
+
+    bool strict = false;
+    bool verbose = false;
+    void (*abortHandler)() = nullptr;
+    long frame = 0;
+    // steady-state frames that allocated during update/draw
+    long offendingFrames = 0;
+    long steadyFrom = WARMUP_FRAMES;
+
+    thread_local AllocTracker::Phase currentPhase = AllocTracker::Other;
+    thread_local const IState *currentState = nullptr;
+    thread_local int allowedDepth = 0;
+
+    StateCounts *countsFor(const IState *state) {
+        const char *name = state ? state->getName().c_str() : "<none>";
+        for (int i = 0; i < stateCountsUsed; i++) {
+            if (std::strncmp(stateCounts[i].name, name, sizeof(stateCounts[i].name) - 1) == 0)
+                return &stateCounts[i];
+        }
+        if (stateCountsUsed == MAX_TRACKED_STATES)
+            return nullptr;
+        StateCounts *counts = &stateCounts[stateCountsUsed++];
+        std::strncpy(counts->name, name, sizeof(counts->name) - 1);
+        return counts;
+    }
+
+    bool isSteadyState() {
+        return frame >= steadyFrom;
+    }
+}
+
+/// setup
+void AllocTracker::init() {
+    const char *env = std::getenv("PONGPONG_ALLOC_STRICT");
+    strict = env && std::strcmp(env, "0") != 0;
+    if (strict)
+        std::fprintf(stderr, "alloc tracker: strict mode enabled\n");
+    env = std::getenv("PONGPONG_ALLOC_VERBOSE");
+    verbose = env && std::strcmp(env, "0") != 0;
+}
+
+void AllocTracker::setAbortHandler(void (*handler)()) {
+    abortHandler = handler;
+}
+
+bool AllocTracker::isStrict() {
+    return strict;
+}
+
+/// frames
+void AllocTracker::beginFrame() {
+    for (auto &counts : frameCounts)
+        counts = Counts();
+}
+
+void AllocTracker::endFrame() {
+    if (isSteadyState() && (frameCounts[Update].allocations || frameCounts[Draw].allocations)) {
+        offendingFrames++;
+        // printing every frame would cause the hitches we are looking for, so only on request
+        for (int p = Update; p <= Draw && (strict || verbose); p++) {
+            if (frameCounts[p].allocations)
+                std::fprintf(stderr, "alloc tracker: frame %ld %s allocated %zu times (%zu bytes)\n",
+                             frame, PHASE_NAMES[p], frameCounts[p].allocations, frameCounts[p].bytes);
+        }
+    }
+    if (strict && violated) {
+        std::fprintf(stderr, "alloc tracker: steady state allocation in %s of %s, aborting\n",
+                     PHASE_NAMES[violationPhase], violationState);
+        report();
+        if (abortHandler)
+            abortHandler();
+        std::abort();
+    }
+    frame++;
+}
+
+void AllocTracker::markTransition() {
+    steadyFrom = frame + WARMUP_FRAMES;
+}
+
+void AllocTracker::report() {
+    std::fprintf(stderr, "alloc tracker: %ld frames, %ld steady-state frames allocated during update/draw\n",
+                 frame, offendingFrames);
+    for (int p = 0; p < PhaseCount; p++) {
+        std::fprintf(stderr, "  %-12s %10zu allocs %10zu frees %12zu bytes\n", PHASE_NAMES[p],
+                     totalAllocations[p].load(), totalFrees[p].load(), totalBytes[p].load());
+    }
+    for (int i = 0; i < stateCountsUsed; i++) {
+        std::fprintf(stderr, "  %s\n", stateCounts[i].name);
+        for (int p = HandleInput; p < PhaseCount; p++) {
+            const Counts &counts = stateCounts[i].phases[p];
+            std::fprintf(stderr, "    %-10s %10zu allocs %10zu frees %12zu bytes\n", PHASE_NAMES[p],
+                         counts.allocations, counts.frees, counts.bytes);
+        }
+    }
+}
+
+/// recording
+void AllocTracker::recordAllocation(std::size_t bytes) {
+    Phase phase = currentPhase;
+    totalAllocations[phase].fetch_add(1, std::memory_order_relaxed);
+    totalBytes[phase].fetch_add(bytes, std::memory_order_relaxed);
+    if (phase == Other)
+        return;
+
+    StateCounts *counts = countsFor(currentState);
+    if (counts) {
+        counts->phases[phase].allocations++;
+        counts->phases[phase].bytes += bytes;
+    }
+    if (allowedDepth)
+        return;
+    frameCounts[phase].allocations++;
+    frameCounts[phase].bytes += bytes;
+    if (!violated && (phase == Update || phase == Draw) && isSteadyState()) {
+        violated = true;
+        violationPhase = phase;
+        std::strncpy(violationState, counts ? counts->name : "<unknown>", sizeof(violationState) - 1);
+    }
+}
+
+void AllocTracker::recordFree() {
+    Phase phase = currentPhase;
+    totalFrees[phase].fetch_add(1, std::memory_order_relaxed);
+    if (phase == Other)
+        return;
+
+    frameCounts[phase].frees++;
+    StateCounts *counts = countsFor(currentState);
+    if (counts)
+        counts->phases[phase].frees++;
+}
+
+/// scopes
+AllocTracker::Scope::Scope(Phase phase, const IState *state)
+:   previousPhase(currentPhase),
+    previousState(currentState)
+{
+    currentPhase = phase;
+    if (state)
+        currentState = state;
+}
+
+AllocTracker::Scope::~Scope() {
+    currentPhase = previousPhase;
+    currentState = previousState;
+}
+
+AllocTracker::Allowed::Allowed() {
+    allowedDepth++;
+}
+
+AllocTracker::Allowed::~Allowed() {
+    allowedDepth--;
+}
+
+/// global operator new/delete
+void *operator new(std::size_t size) {
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    AllocTracker::recordAllocation(size);
+    return ptr;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    void *ptr = std::malloc(size ? size : 1);
+    if (ptr)
+        AllocTracker::recordAllocation(size);
+    return ptr;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept {
+    if (!ptr)
+        return;
+    AllocTracker::recordFree();
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    operator delete(ptr);
+}
+
+/// over-aligned operator new/delete (C++17)
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants the size to be a non-zero multiple of the alignment
+    std::size_t rounded = size ? (size + align - 1) / align * align : align;
+    void *ptr = std::aligned_alloc(align, rounded);
+    if (!ptr)
+        throw std::bad_alloc();
+    AllocTracker::recordAllocation(size);
+    return ptr;
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    try {
+        return operator new(size, alignment);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &tag) noexcept {
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    operator delete(ptr);
+}
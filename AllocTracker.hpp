@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+
+class IState;
+
+// Counts heap allocations made through the global operator new/delete
+// (overridden in AllocTracker.cpp) and attributes them to the frame phase
+// and the IState that is currently being processed by the StateManager.
+//
+// Strict mode (enabled with the environment variable PONGPONG_ALLOC_STRICT=1)
+// aborts the game at the end of a frame if anything was allocated during
+// update/draw once the game reached a steady state, i.e. a few frames after
+// the last push/pop on the state stack. Such frames are counted for report(), they are
+// only printed one by one in strict mode or with PONGPONG_ALLOC_VERBOSE=1.
+class AllocTracker {
+public:
+    enum Phase {
+        Other = 0, // outside the frame loop, or another thread
+        HandleInput,
+        Update,
+        Draw,
+        PhaseCount
+    };
+
+    struct Counts {
+        std::size_t allocations = 0;
+        std::size_t frees = 0;
+        std::size_t bytes = 0;
+    };
+
+    // read PONGPONG_ALLOC_STRICT, call once at startup
+    static void init();
+    // called before strict mode aborts, e.g. to flush logs
+    static void setAbortHandler(void (*handler)());
+    static bool isStrict();
+
+    // frame boundaries, called by the main loop
+    static void beginFrame();
+    static void endFrame();
+    // the state stack changed, steady state starts again after some warmup frames
+    static void markTransition();
+    // print the totals per phase and per state
+    static void report();
+
+    // called from operator new/delete, must not allocate
+    static void recordAllocation(std::size_t bytes);
+    static void recordFree();
+
+    // sets the phase (and optionally the state) for the lifetime of the object
+    class Scope {
+    private:
+        Phase previousPhase;
+        const IState *previousState;
+    public:
+        Scope(Phase phase, const IState *state = nullptr);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    // allocations within its lifetime don't count as strict mode violations,
+    // use it for events that are not part of the steady state (e.g. a score change)
+    class Allowed {
+    public:
+        Allowed();
+        ~Allowed();
+        Allowed(const Allowed &) = delete;
+        Allowed &operator=(const Allowed &) = delete;
+    };
+};
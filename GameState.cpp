@@ -1,11 +1,13 @@
 #include "GameState.hpp"
+#include "AllocTracker.hpp"
 // contains only the lengthy method-defintions, the shorter ones are in the hpp
 
 GameState::GameState(std::shared_ptr<StateManager> stateManager, sf::Font *font, PaddleModus leftPlayer, PaddleModus rightPlayer, sf::Vector2f screenSize)
 :   IState("GameState"),
     stateManager(stateManager),
     font(font),
-    screenSize(screenSize)
+    screenSize(screenSize),
+    telemetryMatch(Telemetry::matchStarted())
 {
     // calculate field bounds
     field.left = screenSize.x / 16;
@@ -29,6 +31,7 @@ GameState::GameState(std::shared_ptr<StateManager> stateManager, sf::Font *font,
     shScoreText.setOutlineColor(sf::Color::White);
     shScoreText.setOutlineThickness(4.f);
     shScoreText.setFillColor(sf::Color::Black);
+    updateScoreText();
 
     // playground
     fieldBorders = sf::RectangleShape(field.getSize());
@@ -55,16 +58,17 @@ bool GameState::update(float elapsedSeconds)
 {        
     ///////
     // paddle controller movements
-    posPaddleLeft = movePaddle(
-        posPaddleLeft,
-        ctrlLeft->Act(posBall, dirBall, shPaddleLeft.getGlobalBounds(), shPaddleRight.getGlobalBounds()),
-        SPEED_PADDLE,
-        elapsedSeconds);
-    posPaddleRight = movePaddle(
-        posPaddleRight,
-        ctrlRight->Act(posBall, dirBall*SPEED_BALL, shPaddleRight.getGlobalBounds(), shPaddleLeft.getGlobalBounds()),
-        SPEED_PADDLE,
-        elapsedSeconds);
+    auto actLeft = ctrlLeft->Act(posBall, dirBall, shPaddleLeft.getGlobalBounds(), shPaddleRight.getGlobalBounds());
+    auto actRight = ctrlRight->Act(posBall, dirBall*SPEED_BALL, shPaddleRight.getGlobalBounds(), shPaddleLeft.getGlobalBounds());
+    trackAction(actionLeft, actLeft, TelemetryEvent::Left);
+    trackAction(actionRight, actRight, TelemetryEvent::Right);
+    auto newPosPaddleLeft = movePaddle(posPaddleLeft, actLeft, SPEED_PADDLE, elapsedSeconds);
+    auto newPosPaddleRight = movePaddle(posPaddleRight, actRight, SPEED_PADDLE, elapsedSeconds);
+    rally.travelLeft += fabs(newPosPaddleLeft.y - posPaddleLeft.y);
+    rally.travelRight += fabs(newPosPaddleRight.y - posPaddleRight.y);
+    rally.seconds += elapsedSeconds;
+    posPaddleLeft = newPosPaddleLeft;
+    posPaddleRight = newPosPaddleRight;
     
     
     ///////
@@ -76,13 +80,22 @@ bool GameState::update(float elapsedSeconds)
     ||  (posBall.y + ballRadius.y >= field.bottom && dirBall.y > 0)) {
         dirBall.y *= -1;
     }
+    // the paddle that hit the ball this frame (if any), recorded once the direction is clamped
+    bool paddleHit = false;
+    TelemetryEvent::Side hitSide = TelemetryEvent::Left;
+    float hitOffset = 0;
     // left paddle collision
     if(dirBall.x < 0 && posBall.x - ballRadius.x <= field.left) {
         if(posBall.y+ballRadius.y > posPaddleLeft.y && posBall.y-ballRadius.y < posPaddleLeft.y + shPaddleLeft.getLocalBounds().height){
             dirBall = reflectBallFromPaddle(dirBall, posBall.y, posPaddleLeft.y, shPaddleLeft.getLocalBounds().height);
+            paddleHit = true;
+            hitSide = TelemetryEvent::Left;
+            hitOffset = relativePaddleOffset(posBall.y, posPaddleLeft.y, shPaddleLeft.getLocalBounds().height);
         }
         else {
             score.right++;
+            updateScoreText();
+            endRally(TelemetryEvent::Right);
             dirBall = sf::Vector2f(1, 0); // towards the score gainer
             posBall = field.getCenter();
         }
@@ -91,22 +104,65 @@ bool GameState::update(float elapsedSeconds)
     if(dirBall.x > 0 && posBall.x + ballRadius.x >= field.right){
         if(posBall.y+ballRadius.y > posPaddleRight.y && posBall.y-ballRadius.y < posPaddleRight.y + shPaddleRight.getLocalBounds().height){
             dirBall = reflectBallFromPaddle(dirBall, posBall.y, posPaddleRight.y, shPaddleRight.getLocalBounds().height);
+            paddleHit = true;
+            hitSide = TelemetryEvent::Right;
+            hitOffset = relativePaddleOffset(posBall.y, posPaddleRight.y, shPaddleRight.getLocalBounds().height);
         }
         else {
             score.left++;
+            updateScoreText();
+            endRally(TelemetryEvent::Left);
             dirBall = sf::Vector2f(-1, 0); // towards score gainer
             posBall = field.getCenter();
         }
     }
     dirBall.y = fmax(fmin(dirBall.y, 0.7), -0.7);
+    if(paddleHit) {
+        rally.hits++;
+        Telemetry::paddleHit(telemetryMatch, hitSide, hitOffset, dirBall, rally.hits);
+    }
     posBall += multiply(normalize(dirBall), SPEED_BALL*elapsedSeconds);
 
     // update sprite positions
     shBall.setPosition(posBall-ballRadius);
     shPaddleLeft.setPosition(posPaddleLeft);
     shPaddleRight.setPosition(posPaddleRight);
+    return false;
+}
+
+void GameState::updateScoreText()
+{
+    // a goal is not part of the steady state
+    AllocTracker::Allowed allowed;
     shScoreText.setString(std::to_string(score.left) + " : " + std::to_string(score.right));
     sf::Vector2f scorePos(field.getCenter().x - shScoreText.getLocalBounds().width/2, field.top - shScoreText.getCharacterSize());
     shScoreText.setPosition(scorePos);
-    return false;
+}
+
+void GameState::trackAction(ActionTrack &track, IPaddleController::Action action, TelemetryEvent::Side side)
+{
+    if(action != track.action) {
+        Telemetry::actionChanged(telemetryMatch, side, action, track.frames);
+        track.action = action;
+        track.frames = 0;
+    }
+    track.frames++;
+}
+
+void GameState::endRally(TelemetryEvent::Side scorer)
+{
+    Telemetry::goal(telemetryMatch, scorer, rally.hits, rally.travelLeft, rally.travelRight, rally.seconds);
+    rally.hits = 0;
+    rally.seconds = 0;
+    rally.travelLeft = 0;
+    rally.travelRight = 0;
+}
+
+void GameState::endMatch()
+{
+    if(matchEnded)
+        return;
+    matchEnded = true;
+    Telemetry::matchEnded(telemetryMatch, actionLeft.action, actionLeft.frames, actionRight.action, actionRight.frames,
+                          rally.hits, rally.travelLeft, rally.travelRight, rally.seconds);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "helpers.hpp"
 #include <memory>
 #include "MenuState.hpp"
+#include "Telemetry.hpp"
 
 // Contains the game state, logic and visualization
 // Two paddles, a rectangle, a ball. The ball is reflected
@@ -65,6 +66,31 @@ private:
     sf::Font* const font;
     sf::Vector2f const screenSize;
 
+    // telemetry: id of this match, stats of the current rally
+    // and how long each paddle controller keeps its current action
+    uint32_t telemetryMatch;
+    struct {
+        uint32_t hits = 0;
+        float seconds = 0;
+        float travelLeft = 0;
+        float travelRight = 0;
+    } rally;
+    struct ActionTrack {
+        IPaddleController::Action action = IPaddleController::Action::None;
+        uint32_t frames = 0;
+    } actionLeft, actionRight;
+
+    // records an action change of a paddle controller
+    void trackAction(ActionTrack &track, IPaddleController::Action action, TelemetryEvent::Side side);
+    // records the goal and starts a new rally
+    void endRally(TelemetryEvent::Side scorer);
+    // records the unfinished rally and the last action of both paddles, only once
+    bool matchEnded = false;
+    void endMatch();
+
+    // rebuild the score text, only call it when the score changed - it allocates
+    void updateScoreText();
+
 public:
     enum PaddleModus {
         Keyboard = 0,
@@ -72,6 +98,10 @@ public:
     };
 
     GameState(std::shared_ptr<StateManager> stateManager, sf::Font *font, PaddleModus leftPlayer, PaddleModus rightPlayer, sf::Vector2f screenSize);
+    // a match that is still running (window closed, quit) ends here
+    ~GameState(){
+        endMatch();
+    }
     // pause on escape
     bool handleInput(const sf::Event &input){
         if(input.type == sf::Event::EventType::KeyReleased && input.key.code == sf::Keyboard::Key::Escape)    
@@ -82,11 +112,12 @@ public:
                 StringAction(std::string("Back to main menu"),
                             [this](ActionState*s){
                                     s->dispose(); // mark pause menu to be removed
+                                    this->endMatch();
                                     this->dispose(); // and the game, too
                             })
             };
             // add pause menu
-            stateManager->push(std::make_unique<MenuState>(std::string("pause"), stateManager, font, screenSize, pauseMenuActions, AllowedForwardActions(false, false, true)));
+            stateManager->push(std::make_unique<MenuState>(std::string("pause"), stateManager, font, screenSize, std::move(pauseMenuActions), AllowedForwardActions(false, false, true)));
         }
     }
     // process keyboard input etc. yes, i know.
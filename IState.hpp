@@ -12,7 +12,7 @@ class IState {
         /// creates a state that can print it's name
         IState(std::string name)
         : name(name) {};
-        ~IState()
+        virtual ~IState()
         {
             dispose();
         }
@@ -27,6 +27,9 @@ class IState {
         bool isDisposed() const{
             return disposed;
         }
+        const std::string &getName() const {
+            return name;
+        }
 
         /// IState overridable interface:
         /// return true if you want the updates to bubble through lower states
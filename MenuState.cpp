@@ -8,13 +8,13 @@ MenuState::MenuState(std::string name, std::shared_ptr<StateManager> stateMgr, s
                      std::vector<StringAction> itemsAndActions, AllowedForwardActions forwardActions)
 :   IState("Menu<"+name+">"),
     stateManager(stateMgr),
-    itemActions(itemsAndActions),
+    itemActions(std::move(itemsAndActions)),
     font(font),
     screenSize(screenSize),
     forwardActions(forwardActions)
 {
     sf::Vector2f position(screenSize.x/2, screenSize.y/12);
-    for(auto entry : itemsAndActions){
+    for(const auto &entry : itemActions){
         sf::Text text;
         text.setFont(*font);
         text.setCharacterSize(40.f);
@@ -66,7 +66,7 @@ bool MenuState::update(float elapsedSeconds) {
 void MenuState::draw(sf::RenderTarget &canvas) {
     if(isDisposed())
         return;
-    for(auto entry : shTexts){
+    for(const auto &entry : shTexts){
         canvas.draw(entry);
     }
 }
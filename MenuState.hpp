@@ -12,8 +12,8 @@ struct StringAction {
     std::string name;
     std::function<void(ActionState *self)> action;
     StringAction(std::string name, std::function<void(ActionState *self)> action)
-    :   name(name), 
-        action(action) 
+    :   name(std::move(name)), 
+        action(std::move(action)) 
     {
     }
 };
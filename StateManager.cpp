@@ -1,4 +1,5 @@
 #include "StateManager.hpp"
+#include "AllocTracker.hpp"
 
 /// ctors
 StateManager::StateManager()
@@ -13,6 +14,7 @@ void StateManager::cleanUpDisposed(){
         if((*it)->isDisposed()){
             it = stateStack.erase(it);
             it--; 
+            AllocTracker::markTransition();
         }
     }
 }
@@ -22,9 +24,15 @@ bool StateManager::noStatesLeft(){
     return stateStack.empty();
 }
 
+void StateManager::clear(){
+    while(!stateStack.empty())
+        stateStack.pop_back();
+}
+
 void StateManager::push(std::unique_ptr<IState> state){
     std::cout << "stm push (len: " << stateStack.size() << std::endl;
     stateStack.push_back(std::move(state));
+    AllocTracker::markTransition();
     std::cout << "         (len: " << stateStack.size() << std::endl;
 }
 
@@ -34,6 +42,7 @@ bool StateManager::handleInput(const sf::Event &input) {
     for (auto it = stateStack.rbegin(); it != stateStack.rend(); it++){
         std::cout << "   ...";
         (*it)->print();
+        AllocTracker::Scope scope(AllocTracker::HandleInput, it->get());
         if(!(*it)->handleInput(input))
             break;
     }
@@ -45,6 +54,7 @@ bool StateManager::update(float elapsedSeconds) {
     for (auto it = stateStack.rbegin(); it != stateStack.rend(); it++){
         std::cout << "   ...";
         (*it)->print();
+        AllocTracker::Scope scope(AllocTracker::Update, it->get());
         if(!(*it)->update(elapsedSeconds))
             break;
     }
@@ -68,6 +78,7 @@ void StateManager::draw(sf::RenderTarget &canvas) {
     for (int i = lowestDrawableStateId; i < stateStack.size(); i++){
         std::cout << "   ...";
         stateStack[i]->print();
+        AllocTracker::Scope scope(AllocTracker::Draw, stateStack[i].get());
         stateStack[i]->draw(canvas);
     }
     
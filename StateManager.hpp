@@ -17,6 +17,8 @@ public:
     bool noStatesLeft();
     void push(std::unique_ptr<IState> state);
     std::unique_ptr<IState> pop();
+    // destroys all states, topmost first
+    void clear();
 
     // state implementation
     bool handleInput(const sf::Event &input) override;
@@ -0,0 +1,201 @@
+#include "Telemetry.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+namespace {
+    // must be a power of two, ~450KB - far more than a few milliseconds of gameplay produce
+    const uint32_t RING_CAPACITY = 1 << 14;
+    const uint32_t RING_MASK = RING_CAPACITY - 1;
+    // events per encoded block, bigger blocks compress better
+    const size_t BLOCK_EVENTS = 4096;
+    // a block collects up to one full ring on top of BLOCK_EVENTS - 1
+    static_assert(BLOCK_EVENTS - 1 + RING_CAPACITY <= TELEMETRY_MAX_BLOCK_EVENTS, "telemetry blocks would be too big for readers");
+    // a smaller block is written if the first event of it waited that long,
+    // so a crash or abort loses at most that much
+    const auto BLOCK_MAX_AGE = std::chrono::seconds(1);
+    const auto WRITER_IDLE = std::chrono::milliseconds(5);
+
+    // single producer (game thread) / single consumer (writer thread)
+    TelemetryEvent ring[RING_CAPACITY];
+    std::atomic<uint32_t> ringHead{0}; // next slot to write, owned by the producer
+    std::atomic<uint32_t> ringTail{0}; // next slot to read, owned by the consumer
+    std::atomic<uint64_t> dropped{0};
+
+    bool enabled = false;
+    uint32_t matchCounter = 0;
+    std::chrono::steady_clock::time_point startTime;
+    FILE *file = nullptr;
+    std::thread writer;
+    std::atomic<bool> running{false};
+
+    void push(TelemetryEvent &event) {
+        event.timeMs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime).count());
+        uint32_t head = ringHead.load(std::memory_order_relaxed);
+        if (head - ringTail.load(std::memory_order_acquire) == RING_CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring[head & RING_MASK] = event;
+        ringHead.store(head + 1, std::memory_order_release);
+    }
+
+    // moves everything that is in the ring into block, returns the number of moved events
+    size_t drain(std::vector<TelemetryEvent> &block) {
+        uint32_t tail = ringTail.load(std::memory_order_relaxed);
+        uint32_t head = ringHead.load(std::memory_order_acquire);
+        for (uint32_t i = tail; i != head; i++)
+            block.push_back(ring[i & RING_MASK]);
+        ringTail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    // writes and flushes the block, after the first failure everything is discarded
+    void writeBlock(std::vector<TelemetryEvent> &block, std::vector<uint8_t> &buffer, bool &failed) {
+        if (!failed && (!writeTelemetryBlock(file, block, buffer) || std::fflush(file) != 0)) {
+            failed = true;
+            std::cout << "telemetry: writing failed, recording stopped" << std::endl;
+        }
+        block.clear();
+    }
+
+    void writeLoop() {
+        std::vector<TelemetryEvent> block;
+        std::vector<uint8_t> buffer;
+        block.reserve(BLOCK_EVENTS + RING_CAPACITY);
+        bool failed = false;
+        auto blockStart = std::chrono::steady_clock::now();
+        while (running.load(std::memory_order_acquire)) {
+            bool wasEmpty = block.empty();
+            if (!drain(block))
+                std::this_thread::sleep_for(WRITER_IDLE);
+            if (wasEmpty && !block.empty())
+                blockStart = std::chrono::steady_clock::now();
+            if (block.size() >= BLOCK_EVENTS
+            ||  (!block.empty() && std::chrono::steady_clock::now() - blockStart >= BLOCK_MAX_AGE))
+                writeBlock(block, buffer, failed);
+        }
+        // the game thread is done, write the rest
+        drain(block);
+        if (!block.empty())
+            writeBlock(block, buffer, failed);
+    }
+}
+
+/// setup
+void Telemetry::init() {
+    const char *path = std::getenv("PONGPONG_TELEMETRY");
+    if (!path || !*path)
+        return;
+    file = std::fopen(path, "wb");
+    if (!file || !writeTelemetryHeader(file)) {
+        std::cout << "telemetry: can't write to " << path << std::endl;
+        if (file)
+            std::fclose(file);
+        file = nullptr;
+        return;
+    }
+    std::cout << "telemetry: writing to " << path << std::endl;
+    startTime = std::chrono::steady_clock::now();
+    enabled = true;
+    running.store(true, std::memory_order_release);
+    writer = std::thread(writeLoop);
+}
+
+void Telemetry::shutdown() {
+    if (!enabled)
+        return;
+    enabled = false;
+    running.store(false, std::memory_order_release);
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+    if (dropped.load())
+        std::cout << "telemetry: dropped " << dropped.load() << " events" << std::endl;
+}
+
+bool Telemetry::isEnabled() {
+    return enabled;
+}
+
+/// recording
+uint32_t Telemetry::matchStarted() {
+    uint32_t match = matchCounter++;
+    if (!enabled)
+        return match;
+    TelemetryEvent event;
+    event.match = match;
+    event.type = TelemetryEvent::MatchStart;
+    push(event);
+    return match;
+}
+
+void Telemetry::paddleHit(uint32_t match, TelemetryEvent::Side side, float relativeOffset, sf::Vector2f ballDir, uint32_t rallyHits) {
+    if (!enabled)
+        return;
+    TelemetryEvent event;
+    event.match = match;
+    event.type = TelemetryEvent::PaddleHit;
+    event.side = side;
+    event.values[0] = relativeOffset;
+    event.values[1] = ballDir.x;
+    event.values[2] = ballDir.y;
+    event.count = rallyHits;
+    push(event);
+}
+
+void Telemetry::goal(uint32_t match, TelemetryEvent::Side scorer, uint32_t rallyHits, float travelLeft, float travelRight, float rallySeconds) {
+    if (!enabled)
+        return;
+    TelemetryEvent event;
+    event.match = match;
+    event.type = TelemetryEvent::Goal;
+    event.side = scorer;
+    event.values[0] = travelLeft;
+    event.values[1] = travelRight;
+    event.values[2] = rallySeconds;
+    event.count = rallyHits;
+    push(event);
+}
+
+void Telemetry::matchEnded(uint32_t match, IPaddleController::Action actionLeft, uint32_t framesHeldLeft,
+                           IPaddleController::Action actionRight, uint32_t framesHeldRight,
+                           uint32_t rallyHits, float travelLeft, float travelRight, float rallySeconds) {
+    if (!enabled)
+        return;
+    TelemetryEvent event;
+    event.match = match;
+    event.type = TelemetryEvent::ActionEnd;
+    event.side = TelemetryEvent::Left;
+    event.action = static_cast<uint8_t>(actionLeft);
+    event.count = framesHeldLeft;
+    push(event);
+    event.side = TelemetryEvent::Right;
+    event.action = static_cast<uint8_t>(actionRight);
+    event.count = framesHeldRight;
+    push(event);
+
+    event = TelemetryEvent();
+    event.match = match;
+    event.type = TelemetryEvent::MatchEnd;
+    event.values[0] = travelLeft;
+    event.values[1] = travelRight;
+    event.values[2] = rallySeconds;
+    event.count = rallyHits;
+    push(event);
+}
+
+void Telemetry::actionChanged(uint32_t match, TelemetryEvent::Side side, IPaddleController::Action action, uint32_t framesHeld) {
+    if (!enabled)
+        return;
+    TelemetryEvent event;
+    event.match = match;
+    event.type = TelemetryEvent::ActionChange;
+    event.side = side;
+    event.action = static_cast<uint8_t>(action);
+    event.count = framesHeld;
+    push(event);
+}
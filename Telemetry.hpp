@@ -0,0 +1,29 @@
+#pragma once
+#include "TelemetryFormat.hpp"
+#include "IPaddleController.hpp"
+
+// Streams gameplay events of every match into a telemetry file (see TelemetryFormat.hpp).
+// Enabled with the environment variable PONGPONG_TELEMETRY=<file>.
+//
+// The game thread pushes events into a fixed size single-producer/single-consumer ring buffer,
+// a background thread drains it and writes the encoded blocks. Pushing never blocks or allocates:
+// if the writer can't keep up, events are dropped and counted.
+// All recording methods must be called from the game thread only.
+class Telemetry {
+public:
+    // read PONGPONG_TELEMETRY and start the writer thread, call once at startup
+    static void init();
+    // stop the writer thread and flush everything that is left
+    static void shutdown();
+    static bool isEnabled();
+
+    // returns the id of the new match
+    static uint32_t matchStarted();
+    static void paddleHit(uint32_t match, TelemetryEvent::Side side, float relativeOffset, sf::Vector2f ballDir, uint32_t rallyHits);
+    static void goal(uint32_t match, TelemetryEvent::Side scorer, uint32_t rallyHits, float travelLeft, float travelRight, float rallySeconds);
+    // the match was left: the action each paddle held at the end and the unfinished rally
+    static void matchEnded(uint32_t match, IPaddleController::Action actionLeft, uint32_t framesHeldLeft,
+                           IPaddleController::Action actionRight, uint32_t framesHeldRight,
+                           uint32_t rallyHits, float travelLeft, float travelRight, float rallySeconds);
+    static void actionChanged(uint32_t match, TelemetryEvent::Side side, IPaddleController::Action action, uint32_t framesHeld);
+};
@@ -0,0 +1,264 @@
+#include "TelemetryFormat.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const char FILE_MAGIC[4] = {'P', 'P', 'T', 'L'};
+    const char BLOCK_MAGIC[4] = {'P', 'P', 'B', 'K'};
+    // protect the reader from corrupt headers: every event needs at least a byte in each
+    // of the six columns that are not run-length encoded, and at most ~60 bytes overall
+    const uint32_t MIN_EVENT_BYTES = 6;
+    const uint32_t MAX_BLOCK_PAYLOAD = TELEMETRY_MAX_BLOCK_EVENTS * 64 + 1024;
+    // fixed point values are saturated to the range a double represents exactly
+    const double MAX_FIXED = 9007199254740992.; // 2^53
+
+    // column encodings, stored in front of every column
+    enum Encoding : uint8_t {
+        // zigzag varint of the difference to the previous value
+        DeltaVarint = 0,
+        // pairs of (varint run length, byte value)
+        RunLength,
+        // zigzag varint of the fixed point value
+        FixedVarint,
+        // plain varint
+        Varint
+    };
+
+    /// primitive writers/readers
+    void putU32(std::vector<uint8_t> &out, uint32_t value) {
+        for (int i = 0; i < 4; i++)
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    uint32_t getU32(const uint8_t *data) {
+        return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    void putVarint(std::vector<uint8_t> &out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool getVarint(const uint8_t *&data, const uint8_t *end, uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 70 && data < end; shift += 7) {
+            uint8_t byte = *data++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    bool getVarint(const uint8_t *&data, const uint8_t *end, uint32_t &value) {
+        uint64_t wide;
+        if (!getVarint(data, end, wide) || wide > UINT32_MAX)
+            return false;
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    uint32_t zigzag(int32_t value) {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    int32_t unzigzag(uint32_t value) {
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+
+    uint64_t zigzag64(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag64(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    int64_t toFixed(float value) {
+        double fixed = std::round(static_cast<double>(value) * TELEMETRY_VALUE_SCALE);
+        if (std::isnan(fixed))
+            return 0;
+        return static_cast<int64_t>(std::fmax(std::fmin(fixed, MAX_FIXED), -MAX_FIXED));
+    }
+
+    /// columns
+    // writes the column header, the length is patched in by endColumn
+    size_t beginColumn(std::vector<uint8_t> &out, Encoding encoding) {
+        out.push_back(encoding);
+        putU32(out, 0);
+        return out.size();
+    }
+
+    void endColumn(std::vector<uint8_t> &out, size_t start) {
+        uint32_t length = static_cast<uint32_t>(out.size() - start);
+        for (int i = 0; i < 4; i++)
+            out[start - 4 + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+
+    template<typename Get>
+    void encodeDelta(std::vector<uint8_t> &out, const std::vector<TelemetryEvent> &events, Get get) {
+        size_t start = beginColumn(out, DeltaVarint);
+        uint32_t previous = 0;
+        for (const auto &event : events) {
+            uint32_t value = get(event);
+            putVarint(out, zigzag(static_cast<int32_t>(value - previous)));
+            previous = value;
+        }
+        endColumn(out, start);
+    }
+
+    template<typename Get>
+    void encodeRunLength(std::vector<uint8_t> &out, const std::vector<TelemetryEvent> &events, Get get) {
+        size_t start = beginColumn(out, RunLength);
+        for (size_t i = 0; i < events.size();) {
+            uint8_t value = get(events[i]);
+            size_t run = 1;
+            while (i + run < events.size() && get(events[i + run]) == value)
+                run++;
+            putVarint(out, static_cast<uint32_t>(run));
+            out.push_back(value);
+            i += run;
+        }
+        endColumn(out, start);
+    }
+
+    void encodeFixed(std::vector<uint8_t> &out, const std::vector<TelemetryEvent> &events, int valueIndex) {
+        size_t start = beginColumn(out, FixedVarint);
+        for (const auto &event : events)
+            putVarint(out, zigzag64(toFixed(event.values[valueIndex])));
+        endColumn(out, start);
+    }
+
+    void encodeCount(std::vector<uint8_t> &out, const std::vector<TelemetryEvent> &events) {
+        size_t start = beginColumn(out, Varint);
+        for (const auto &event : events)
+            putVarint(out, event.count);
+        endColumn(out, start);
+    }
+
+    // decodes one column into the member of every event selected by set
+    template<typename Set>
+    bool decodeColumn(const uint8_t *&data, const uint8_t *end, std::vector<TelemetryEvent> &events, Set set) {
+        if (end - data < 5)
+            return false;
+        uint8_t encoding = data[0];
+        uint32_t length = getU32(data + 1);
+        data += 5;
+        if (static_cast<size_t>(end - data) < length)
+            return false;
+        const uint8_t *column = data;
+        const uint8_t *columnEnd = data + length;
+        data = columnEnd;
+
+        uint32_t value = 0;
+        switch (encoding) {
+            case DeltaVarint: {
+                uint32_t previous = 0;
+                for (auto &event : events) {
+                    if (!getVarint(column, columnEnd, value))
+                        return false;
+                    previous += static_cast<uint32_t>(unzigzag(value));
+                    set(event, static_cast<float>(0), previous);
+                }
+                return true;
+            }
+            case RunLength: {
+                size_t i = 0;
+                while (i < events.size()) {
+                    if (!getVarint(column, columnEnd, value) || column == columnEnd || value == 0 || i + value > events.size())
+                        return false;
+                    uint8_t byte = *column++;
+                    for (size_t runEnd = i + value; i < runEnd; i++)
+                        set(events[i], static_cast<float>(0), byte);
+                }
+                return true;
+            }
+            case FixedVarint: {
+                uint64_t fixed = 0;
+                for (auto &event : events) {
+                    if (!getVarint(column, columnEnd, fixed))
+                        return false;
+                    set(event, static_cast<float>(static_cast<double>(unzigzag64(fixed)) / TELEMETRY_VALUE_SCALE), 0u);
+                }
+                return true;
+            }
+            case Varint:
+                for (auto &event : events) {
+                    if (!getVarint(column, columnEnd, value))
+                        return false;
+                    set(event, static_cast<float>(0), value);
+                }
+                return true;
+        }
+        return false;
+    }
+}
+
+bool writeTelemetryHeader(FILE *file) {
+    std::vector<uint8_t> header(FILE_MAGIC, FILE_MAGIC + 4);
+    putU32(header, TELEMETRY_VERSION);
+    return std::fwrite(header.data(), 1, header.size(), file) == header.size();
+}
+
+bool readTelemetryHeader(FILE *file) {
+    uint8_t header[8];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header))
+        return false;
+    return std::memcmp(header, FILE_MAGIC, 4) == 0 && getU32(header + 4) == TELEMETRY_VERSION;
+}
+
+bool writeTelemetryBlock(FILE *file, const std::vector<TelemetryEvent> &events, std::vector<uint8_t> &buffer) {
+    if (events.size() > TELEMETRY_MAX_BLOCK_EVENTS)
+        return false;
+    buffer.assign(BLOCK_MAGIC, BLOCK_MAGIC + 4);
+    putU32(buffer, static_cast<uint32_t>(events.size()));
+    putU32(buffer, 0); // payload length, patched below
+    size_t payloadStart = buffer.size();
+
+    encodeDelta(buffer, events, [](const TelemetryEvent &e) { return e.match; });
+    encodeDelta(buffer, events, [](const TelemetryEvent &e) { return e.timeMs; });
+    encodeRunLength(buffer, events, [](const TelemetryEvent &e) { return e.type; });
+    encodeRunLength(buffer, events, [](const TelemetryEvent &e) { return e.side; });
+    encodeRunLength(buffer, events, [](const TelemetryEvent &e) { return e.action; });
+    for (int i = 0; i < 3; i++)
+        encodeFixed(buffer, events, i);
+    encodeCount(buffer, events);
+
+    uint32_t payload = static_cast<uint32_t>(buffer.size() - payloadStart);
+    for (int i = 0; i < 4; i++)
+        buffer[payloadStart - 4 + i] = static_cast<uint8_t>(payload >> (8 * i));
+    return std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+}
+
+bool readTelemetryBlock(FILE *file, std::vector<TelemetryEvent> &events, std::vector<uint8_t> &buffer) {
+    uint8_t header[12];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header))
+        return false;
+    if (std::memcmp(header, BLOCK_MAGIC, 4) != 0)
+        return false;
+    uint32_t eventCount = getU32(header + 4);
+    uint32_t payload = getU32(header + 8);
+    if (eventCount > TELEMETRY_MAX_BLOCK_EVENTS || payload > MAX_BLOCK_PAYLOAD
+    ||  static_cast<uint64_t>(eventCount) * MIN_EVENT_BYTES > payload)
+        return false;
+    buffer.resize(payload);
+    if (std::fread(buffer.data(), 1, payload, file) != payload)
+        return false;
+
+    events.assign(eventCount, TelemetryEvent());
+    const uint8_t *data = buffer.data();
+    const uint8_t *end = data + payload;
+    // same order as in writeTelemetryBlock
+    return decodeColumn(data, end, events, [](TelemetryEvent &e, float, uint32_t v) { e.match = v; })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float, uint32_t v) { e.timeMs = v; })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float, uint32_t v) { e.type = static_cast<uint8_t>(v); })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float, uint32_t v) { e.side = static_cast<uint8_t>(v); })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float, uint32_t v) { e.action = static_cast<uint8_t>(v); })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float f, uint32_t) { e.values[0] = f; })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float f, uint32_t) { e.values[1] = f; })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float f, uint32_t) { e.values[2] = f; })
+        && decodeColumn(data, end, events, [](TelemetryEvent &e, float, uint32_t v) { e.count = v; });
+}
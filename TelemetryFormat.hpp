@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// On-disk format of the match telemetry, shared by the game (writer) and telemetry_stats (reader).
+//
+// file   := header block*
+// header := "PPTL" u32:version
+// block  := "PPBK" u32:eventCount u32:payloadBytes column*
+// column := u8:encoding u32:bytes data
+//
+// Every block stores its events column by column (in the order of the TelemetryEvent members),
+// each column with the encoding that suits it best. The byte length in front of every column
+// allows a reader to skip the columns it is not interested in.
+// All integers are little endian, floats are stored as 64 bit fixed point with TELEMETRY_VALUE_SCALE
+// (saturating, so even hours of paddle travel in pixels fit).
+
+const uint32_t TELEMETRY_VERSION = 2;
+const float TELEMETRY_VALUE_SCALE = 10000.f;
+// a block never holds more events, readers reject bigger ones
+const uint32_t TELEMETRY_MAX_BLOCK_EVENTS = 1 << 15;
+
+// one gameplay event, the meaning of side/action/values/count depends on the type
+struct TelemetryEvent {
+    enum Type {
+        MatchStart = 0,
+        // side: paddle, values: relative offset on the paddle (see relativePaddleOffset: -1..1 are the paddle ends,
+        // the ball's edge reaches beyond that, up to +-1.33 with the current sizes), ball direction x/y after clamping,
+        // count: hits in this rally
+        PaddleHit,
+        // side: scorer, values: travel of left/right paddle during the rally, rally duration in seconds, count: hits in the rally
+        Goal,
+        // side: paddle, action: the new IPaddleController::Action, count: frames the previous action was held
+        ActionChange,
+        // the match was left, one per paddle: side: paddle, action: the action it held at the end, count: frames it was held
+        ActionEnd,
+        // the match was left, follows the ActionEnds. values/count: like Goal, for the unfinished rally
+        MatchEnd,
+        TypeCount
+    };
+    enum Side {
+        Left = 0,
+        Right
+    };
+
+    uint32_t match = 0;
+    uint32_t timeMs = 0;
+    uint8_t type = MatchStart;
+    uint8_t side = Left;
+    uint8_t action = 0;
+    float values[3] = {0, 0, 0};
+    uint32_t count = 0;
+};
+
+bool writeTelemetryHeader(FILE *file);
+// returns false if the file is no telemetry file or has an unknown version
+bool readTelemetryHeader(FILE *file);
+
+// encodes the events into one block and writes it, buffer is reused to avoid allocations
+// fails for more than TELEMETRY_MAX_BLOCK_EVENTS events
+bool writeTelemetryBlock(FILE *file, const std::vector<TelemetryEvent> &events, std::vector<uint8_t> &buffer);
+// reads the next block into events (replacing its content), returns false at the end of the file or on corrupt data
+bool readTelemetryBlock(FILE *file, std::vector<TelemetryEvent> &events, std::vector<uint8_t> &buffer);
@@ -23,9 +23,13 @@ sf::Vector2f keepInBounds(const sf::Vector2f obj, const sf::FloatRect bounds){
     );
 }
 
-sf::Vector2f reflectBallFromPaddle(sf::Vector2f ballDir, float ballY, float paddleY, float paddleHeight){
+float relativePaddleOffset(float ballY, float paddleY, float paddleHeight){
     auto offset = ballY - (paddleY + paddleHeight/2);
-    auto relativeOffset = offset / (paddleHeight/2);
+    return offset / (paddleHeight/2);
+}
+
+sf::Vector2f reflectBallFromPaddle(sf::Vector2f ballDir, float ballY, float paddleY, float paddleHeight){
+    auto relativeOffset = relativePaddleOffset(ballY, paddleY, paddleHeight);
     auto relativeOffsetSquaredSigned = relativeOffset * fabs(relativeOffset) * fabs(relativeOffset);
     return sf::Vector2f(-ballDir.x, ballDir.y + relativeOffsetSquaredSigned);
 }
@@ -14,6 +14,11 @@ float keepInBounds(float obj, float min, float max);
 
 sf::Vector2f keepInBounds(const sf::Vector2f obj, const sf::FloatRect bounds);
 
+// where the ball at height ballY hits the paddle defined by paddleY to paddleY+paddleHeight
+// -1 is the top end, 0 the center and 1 the bottom end of the paddle. The ball counts as a hit while
+// its edge overlaps the paddle, so its center goes up to a ball radius further: +-(1 + 2*radius/paddleHeight)
+float relativePaddleOffset(float ballY, float paddleY, float paddleHeight);
+
 // Reflects the ball at height ballY from the paddle defined by paddleY to paddleY+paddleHeight
 // so that the horizontal direction of the ball reverses but also the vertical aspect changes
 // depending on where the paddle was hit (further to the border of the paddle means more speed in that direction)
@@ -3,13 +3,30 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <cstdlib>
 #include "StateManager.hpp"
 #include "MenuState.hpp"
 #include "GameState.hpp"
+#include "AllocTracker.hpp"
+#include "Telemetry.hpp"
 
+// the states of the running game, so shutdownGame can end them
+static std::weak_ptr<StateManager> runningStates;
+
+// ends all states (and with them running matches) and flushes the telemetry,
+// also runs right before strict alloc mode aborts
+static void shutdownGame()
+{
+    if(auto states = runningStates.lock())
+        states->clear();
+    Telemetry::shutdown();
+}
 
 int main()
 {
+    AllocTracker::init();
+    AllocTracker::setAbortHandler(shutdownGame);
+    Telemetry::init();
     // setting up sf window
     sf::RenderWindow window(sf::VideoMode(800, 600), "SFML works!");
     // score
@@ -19,6 +36,7 @@ int main()
 
     //MenuState menuState(font, sf::Vector2f(MID_X, MID_Y-MIN_Y));
     auto stateManager = std::make_shared<StateManager>();
+    runningStates = stateManager;
     
     
     std::vector<StringAction> menuActions {
@@ -53,15 +71,31 @@ int main()
     };
 
     stateManager->push(std::make_unique<MenuState>("main", stateManager, &font, sf::Vector2f(window.getSize()), menuActions, AllowedForwardActions(false, false, true)));
+
+    // scripted run for CI: PONGPONG_AUTOPLAY_FRAMES=N starts AI vs AI right away
+    // and quits after N frames of fixed length (combine with PONGPONG_ALLOC_STRICT=1)
+    const char *autoplayEnv = std::getenv("PONGPONG_AUTOPLAY_FRAMES");
+    long autoplayFrames = autoplayEnv ? std::strtol(autoplayEnv, nullptr, 10) : 0;
+    if(autoplayFrames > 0){
+        stateManager->push(std::make_unique<GameState>(
+            stateManager,
+            &font,
+            GameState::PaddleModus::AI,
+            GameState::PaddleModus::AI,
+            sf::Vector2f(window.getSize())));
+    }
+    long frame = 0;
     
     //clock
     sf::Clock clock;
 
-    while (window.isOpen() && !stateManager->noStatesLeft())
+    while (window.isOpen() && !stateManager->noStatesLeft() && (autoplayFrames <= 0 || frame < autoplayFrames))
     {        
+        AllocTracker::beginFrame();
         sf::Event event;
         while (window.pollEvent(event))
         {
+            AllocTracker::Scope scope(AllocTracker::HandleInput, stateManager.get());
             stateManager->handleInput(event);
             switch(event.type){
                 case sf::Event::Closed:
@@ -72,14 +106,26 @@ int main()
 
         float elapsedSeconds = clock.getElapsedTime().asSeconds();
         clock.restart();
+        if(autoplayFrames > 0)
+            elapsedSeconds = 1.f / 60;
 
-        stateManager->update(elapsedSeconds);
+        {
+            AllocTracker::Scope scope(AllocTracker::Update, stateManager.get());
+            stateManager->update(elapsedSeconds);
+        }
         
         // draw
-        window.clear(sf::Color(0,0,0,10));
-        stateManager->draw(window);
-        window.display();
+        {
+            AllocTracker::Scope scope(AllocTracker::Draw, stateManager.get());
+            window.clear(sf::Color(0,0,0,10));
+            stateManager->draw(window);
+            window.display();
+        }
+        AllocTracker::endFrame();
+        frame++;
     }
 
+    shutdownGame();
+    AllocTracker::report();
     return 0;
 }
\ No newline at end of file
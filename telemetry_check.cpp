@@ -0,0 +1,115 @@
+// Round trip check of the telemetry format: writes blocks using every column encoding,
+// reads them back and compares, then makes sure corrupt block headers are rejected.
+// usage: telemetry_check (exit code 0 on success)
+#include "TelemetryFormat.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    int failures = 0;
+
+    void expect(bool condition, const char *what) {
+        if (!condition) {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    bool sameValue(float a, float b) {
+        return std::fabs(a - b) <= std::fmax(1.f, std::fabs(a)) / TELEMETRY_VALUE_SCALE;
+    }
+
+    bool sameEvent(const TelemetryEvent &a, const TelemetryEvent &b) {
+        return a.match == b.match && a.timeMs == b.timeMs && a.type == b.type && a.side == b.side && a.action == b.action
+            && sameValue(a.values[0], b.values[0]) && sameValue(a.values[1], b.values[1]) && sameValue(a.values[2], b.values[2])
+            && a.count == b.count;
+    }
+
+    // a block with every event type, runs and single values, decreasing deltas and extreme values
+    std::vector<TelemetryEvent> makeEvents(uint32_t firstMatch, size_t count) {
+        std::vector<TelemetryEvent> events;
+        for (size_t i = 0; i < count; i++) {
+            TelemetryEvent event;
+            event.match = firstMatch + static_cast<uint32_t>(i / 50);
+            event.timeMs = static_cast<uint32_t>(i * 7 % 1000 + i); // not monotonic
+            event.type = static_cast<uint8_t>(i / 3 % TelemetryEvent::TypeCount);
+            event.side = static_cast<uint8_t>(i / 2 % 2);
+            event.action = static_cast<uint8_t>(i % 3);
+            event.values[0] = (static_cast<int>(i % 21) - 10) / 10.f;
+            event.values[1] = i % 2 ? 1.f : -1.f;
+            event.values[2] = 0.7f * (static_cast<int>(i % 3) - 1);
+            event.count = static_cast<uint32_t>(i * i);
+            events.push_back(event);
+        }
+        // paddle travel far beyond 32 bit fixed point, and the largest integers
+        events.back().values[0] = 5000000.f;
+        events.back().values[1] = -5000000.f;
+        events.back().count = UINT32_MAX;
+        events.back().timeMs = UINT32_MAX;
+        return events;
+    }
+
+    void checkRoundTrip() {
+        FILE *file = std::tmpfile();
+        std::vector<uint8_t> buffer;
+        std::vector<std::vector<TelemetryEvent>> blocks = {makeEvents(0, TELEMETRY_MAX_BLOCK_EVENTS), makeEvents(3, 1), {}, makeEvents(UINT32_MAX - 200, 300)};
+        expect(writeTelemetryHeader(file), "write header");
+        for (const auto &block : blocks)
+            expect(writeTelemetryBlock(file, block, buffer), "write block");
+
+        std::rewind(file);
+        expect(readTelemetryHeader(file), "read header");
+        std::vector<TelemetryEvent> events;
+        for (const auto &block : blocks) {
+            if (!readTelemetryBlock(file, events, buffer)) {
+                expect(false, "read block");
+                break;
+            }
+            expect(events.size() == block.size(), "event count");
+            for (size_t i = 0; i < events.size() && i < block.size(); i++) {
+                if (!sameEvent(events[i], block[i])) {
+                    expect(false, "event round trip");
+                    break;
+                }
+            }
+        }
+        expect(!readTelemetryBlock(file, events, buffer), "end of file");
+        expect(!writeTelemetryBlock(file, makeEvents(0, TELEMETRY_MAX_BLOCK_EVENTS + 1), buffer), "refuse oversized block");
+        std::fclose(file);
+    }
+
+    // writes a header and a block whose event count/payload length are replaced
+    void checkCorruptHeader(uint32_t eventCount, uint32_t payload, const char *what) {
+        FILE *file = std::tmpfile();
+        std::vector<uint8_t> buffer;
+        writeTelemetryHeader(file);
+        writeTelemetryBlock(file, makeEvents(0, 10), buffer);
+        std::fseek(file, 8 + 4, SEEK_SET);
+        uint8_t header[8];
+        for (int i = 0; i < 4; i++) {
+            header[i] = static_cast<uint8_t>(eventCount >> (8 * i));
+            header[4 + i] = static_cast<uint8_t>(payload >> (8 * i));
+        }
+        std::fwrite(header, 1, sizeof(header), file);
+
+        std::rewind(file);
+        std::vector<TelemetryEvent> events;
+        expect(readTelemetryHeader(file), "read header");
+        expect(!readTelemetryBlock(file, events, buffer), what);
+        std::fclose(file);
+    }
+}
+
+int main()
+{
+    checkRoundTrip();
+    checkCorruptHeader(0x7fffffff, 200, "reject huge event count");
+    checkCorruptHeader(10, 0xffffffff, "reject huge payload");
+    checkCorruptHeader(10, 20, "reject truncated payload");
+    checkCorruptHeader(TELEMETRY_MAX_BLOCK_EVENTS + 1, 1 << 20, "reject too many events");
+    if (failures)
+        return 1;
+    std::printf("telemetry format ok\n");
+    return 0;
+}
@@ -0,0 +1,206 @@
+// Offline tool printing aggregate statistics over telemetry files written by the game
+// usage: telemetry_stats <file>...
+#include "TelemetryFormat.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // relative paddle offsets in steps of 0.2 from -1.4 to 1.4 (edge hits go up to about +-1.33),
+    // the first and last bucket collect anything below/above
+    const float OFFSET_MIN = -1.4f;
+    const float OFFSET_STEP = 0.2f;
+    const int OFFSET_BUCKETS = 14 + 2;
+    const int RALLY_BUCKETS = 6; // 0, 1, 2-3, 4-7, 8-15, 16+ hits
+    const int ACTIONS = 3; // IPaddleController::Action, without pulling in SFML
+    const char *const ACTION_NAMES[ACTIONS] = {"none", "up", "down"};
+    const char *const SIDE_NAMES[2] = {"left", "right"};
+    const float BALL_DIR_CLAMP = 0.7f;
+
+    struct Stats {
+        uint64_t files = 0;
+        uint64_t blocks = 0;
+        uint64_t events = 0;
+        uint64_t matches = 0;
+
+        uint64_t hits[2] = {0, 0};
+        double offsetSum = 0;
+        double offsetAbsSum = 0;
+        uint64_t offsetBuckets[OFFSET_BUCKETS] = {};
+        double dirYAbsSum = 0;
+        uint64_t dirYClamped = 0;
+
+        uint64_t goals[2] = {0, 0};
+        uint64_t rallyHitsSum = 0;
+        uint32_t rallyHitsMax = 0;
+        uint64_t rallyBuckets[RALLY_BUCKETS] = {};
+        double rallySecondsSum = 0;
+        double travelSum[2] = {0, 0};
+        // rallies cut short by leaving the match
+        uint64_t matchesEnded = 0;
+        uint64_t unfinishedHitsSum = 0;
+        double unfinishedSecondsSum = 0;
+
+        // per side: frames and runs per action, transitions from -> to
+        uint64_t actionFrames[2][ACTIONS] = {};
+        uint64_t actionRuns[2][ACTIONS] = {};
+        uint64_t transitions[2][ACTIONS][ACTIONS] = {};
+        // the action each side is currently holding, every match starts with none
+        uint8_t current[2] = {0, 0};
+    };
+
+    // a run of frames with the same action ended
+    void addActionRun(Stats &stats, int side, uint32_t frames) {
+        stats.actionFrames[side][stats.current[side]] += frames;
+        if (frames)
+            stats.actionRuns[side][stats.current[side]]++;
+    }
+
+    int rallyBucket(uint32_t hits) {
+        int bucket = 0;
+        while (hits && bucket < RALLY_BUCKETS - 1) {
+            hits >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    void accumulate(Stats &stats, const TelemetryEvent &event) {
+        int side = event.side ? 1 : 0;
+        switch (event.type) {
+            case TelemetryEvent::MatchStart:
+                stats.matches++;
+                stats.current[0] = stats.current[1] = 0;
+                break;
+            case TelemetryEvent::PaddleHit: {
+                float offset = event.values[0];
+                stats.hits[side]++;
+                stats.offsetSum += offset;
+                stats.offsetAbsSum += std::fabs(offset);
+                // the epsilon keeps values stored exactly on a bucket edge (e.g. -1.0) in the upper bucket
+                int bucket = static_cast<int>(std::floor((offset - OFFSET_MIN) / OFFSET_STEP + 1e-3)) + 1;
+                stats.offsetBuckets[std::min(std::max(bucket, 0), OFFSET_BUCKETS - 1)]++;
+                stats.dirYAbsSum += std::fabs(event.values[2]);
+                if (std::fabs(event.values[2]) >= BALL_DIR_CLAMP - 1 / TELEMETRY_VALUE_SCALE)
+                    stats.dirYClamped++;
+                break;
+            }
+            case TelemetryEvent::Goal:
+                stats.goals[side]++;
+                stats.rallyHitsSum += event.count;
+                stats.rallyHitsMax = std::max(stats.rallyHitsMax, event.count);
+                stats.rallyBuckets[rallyBucket(event.count)]++;
+                stats.travelSum[0] += event.values[0];
+                stats.travelSum[1] += event.values[1];
+                stats.rallySecondsSum += event.values[2];
+                break;
+            case TelemetryEvent::ActionChange:
+                if (event.action >= ACTIONS)
+                    break;
+                addActionRun(stats, side, event.count);
+                stats.transitions[side][stats.current[side]][event.action]++;
+                stats.current[side] = event.action;
+                break;
+            case TelemetryEvent::ActionEnd:
+                if (event.action >= ACTIONS)
+                    break;
+                stats.current[side] = event.action;
+                addActionRun(stats, side, event.count);
+                break;
+            case TelemetryEvent::MatchEnd:
+                stats.matchesEnded++;
+                stats.unfinishedHitsSum += event.count;
+                stats.unfinishedSecondsSum += event.values[2];
+                stats.travelSum[0] += event.values[0];
+                stats.travelSum[1] += event.values[1];
+                break;
+        }
+    }
+
+    double ratio(double value, uint64_t total) {
+        return total ? value / total : 0;
+    }
+
+    void print(const Stats &stats) {
+        std::printf("files %llu, blocks %llu, events %llu, matches %llu\n",
+                    (unsigned long long)stats.files, (unsigned long long)stats.blocks,
+                    (unsigned long long)stats.events, (unsigned long long)stats.matches);
+
+        uint64_t hits = stats.hits[0] + stats.hits[1];
+        std::printf("\npaddle hits %llu (left %llu, right %llu)\n", (unsigned long long)hits,
+                    (unsigned long long)stats.hits[0], (unsigned long long)stats.hits[1]);
+        std::printf("  relative offset: mean %+.4f, mean abs %.4f\n", ratio(stats.offsetSum, hits), ratio(stats.offsetAbsSum, hits));
+        std::printf("    [-inf, %+.1f) %6.2f%%\n", OFFSET_MIN, 100 * ratio(stats.offsetBuckets[0], hits));
+        for (int i = 1; i < OFFSET_BUCKETS - 1; i++) {
+            float from = OFFSET_MIN + (i - 1) * OFFSET_STEP;
+            std::printf("    [%+.1f, %+.1f) %6.2f%%\n", from, from + OFFSET_STEP, 100 * ratio(stats.offsetBuckets[i], hits));
+        }
+        std::printf("    [%+.1f, +inf) %6.2f%%\n", OFFSET_MIN + (OFFSET_BUCKETS - 2) * OFFSET_STEP,
+                    100 * ratio(stats.offsetBuckets[OFFSET_BUCKETS - 1], hits));
+        std::printf("  ball direction y after clamp: mean abs %.4f, at clamp %.2f%%\n",
+                    ratio(stats.dirYAbsSum, hits), 100 * ratio(stats.dirYClamped, hits));
+
+        uint64_t rallies = stats.goals[0] + stats.goals[1];
+        std::printf("\nrallies %llu (won left %llu, right %llu)\n", (unsigned long long)rallies,
+                    (unsigned long long)stats.goals[0], (unsigned long long)stats.goals[1]);
+        std::printf("  hits: mean %.2f, max %u\n", ratio(stats.rallyHitsSum, rallies), stats.rallyHitsMax);
+        const char *const bucketNames[RALLY_BUCKETS] = {"0", "1", "2-3", "4-7", "8-15", "16+"};
+        for (int i = 0; i < RALLY_BUCKETS; i++)
+            std::printf("    %-5s %6.2f%%\n", bucketNames[i], 100 * ratio(stats.rallyBuckets[i], rallies));
+        std::printf("  duration: mean %.2fs\n", ratio(stats.rallySecondsSum, rallies));
+        std::printf("  paddle travel: mean left %.1f, right %.1f per match\n",
+                    ratio(stats.travelSum[0], stats.matches), ratio(stats.travelSum[1], stats.matches));
+        std::printf("  unfinished (match left): %llu, mean hits %.2f, mean duration %.2fs\n", (unsigned long long)stats.matchesEnded,
+                    ratio(stats.unfinishedHitsSum, stats.matchesEnded), ratio(stats.unfinishedSecondsSum, stats.matchesEnded));
+
+        for (int side = 0; side < 2; side++) {
+            uint64_t frames = 0;
+            for (int a = 0; a < ACTIONS; a++)
+                frames += stats.actionFrames[side][a];
+            std::printf("\n%s controller actions (%llu frames)\n", SIDE_NAMES[side], (unsigned long long)frames);
+            for (int a = 0; a < ACTIONS; a++) {
+                std::printf("  %-5s %6.2f%% of frames, mean run %.1f frames, next:", ACTION_NAMES[a],
+                            100 * ratio(stats.actionFrames[side][a], frames),
+                            ratio(stats.actionFrames[side][a], stats.actionRuns[side][a]));
+                for (int b = 0; b < ACTIONS; b++)
+                    std::printf(" %s %llu", ACTION_NAMES[b], (unsigned long long)stats.transitions[side][a][b]);
+                std::printf("\n");
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <telemetry file>...\n", argv[0]);
+        return 1;
+    }
+
+    Stats stats;
+    std::vector<TelemetryEvent> events;
+    std::vector<uint8_t> buffer;
+    for (int i = 1; i < argc; i++) {
+        FILE *file = std::fopen(argv[i], "rb");
+        if (!file || !readTelemetryHeader(file)) {
+            std::fprintf(stderr, "skipping %s: not a telemetry file\n", argv[i]);
+            if (file)
+                std::fclose(file);
+            continue;
+        }
+        stats.files++;
+        // match ids restart in every file
+        stats.current[0] = stats.current[1] = 0;
+        while (readTelemetryBlock(file, events, buffer)) {
+            stats.blocks++;
+            stats.events += events.size();
+            for (const auto &event : events)
+                accumulate(stats, event);
+        }
+        if (!std::feof(file))
+            std::fprintf(stderr, "%s: corrupt block after %llu blocks\n", argv[i], (unsigned long long)stats.blocks);
+        std::fclose(file);
+    }
+    print(stats);
+    return 0;
+}